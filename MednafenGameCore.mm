@@ -29,6 +29,7 @@
 #include "state-driver.h"
 #include "mednafen-driver.h"
 #include "MemoryStream.h"
+#include "ExtMemStream.h"
 
 #import "MednafenGameCore.h"
 #import <OpenEmuBase/OERingBuffer.h>
@@ -3487,13 +3488,24 @@ static __weak MednafenGameCore *_current;
 
 - (NSData *)serializeStateWithError:(NSError **)outError
 {
-    MemoryStream stream(65536, false);
-    MDFNSS_SaveSM(&stream, true);
-    size_t length = stream.map_size();
-    void *bytes = stream.map();
+    try
+    {
+        // Serialize straight into the returned buffer, sized up front, to avoid regrowth and copying.
+        size_t length = MDFNSS_GetSMSize(true);
+
+        if(length)
+        {
+            NSMutableData *data = [NSMutableData dataWithLength:length];
+            ExtMemStream stream(data.mutableBytes, length);
+            MDFNSS_SaveSM(&stream, true);
 
-    if(length)
-        return [NSData dataWithBytes:bytes length:length];
+            return data;
+        }
+    }
+    catch(std::exception &e)
+    {
+        NSLog(@"Mednafen: state save error: %s", e.what());
+    }
 
     if(outError) {
         *outError = [NSError errorWithDomain:OEGameCoreErrorDomain code:OEGameCoreCouldNotSaveStateError  userInfo:@{
@@ -3510,11 +3522,29 @@ static __weak MednafenGameCore *_current;
     NSError *error;
     const void *bytes = state.bytes;
     size_t length = state.length;
+    size_t serialSize;
+
+    // Load straight from the caller's buffer, without copying it.
+    ExtMemStream stream(bytes, length);
 
-    MemoryStream stream(length, -1);
-    memcpy(stream.map(), bytes, length);
-    MDFNSS_LoadSM(&stream, true);
-    size_t serialSize = stream.map_size();
+    try
+    {
+        MDFNSS_LoadSM(&stream, true);
+        serialSize = stream.tell();
+    }
+    catch(std::exception &e)
+    {
+        if(outError)
+        {
+            *outError = [NSError errorWithDomain:OEGameCoreErrorDomain
+                                            code:OEGameCoreCouldNotLoadStateError
+                                        userInfo:@{
+                                                   NSLocalizedDescriptionKey : @"The save state data could not be read",
+                                                   NSLocalizedRecoverySuggestionErrorKey : [NSString stringWithUTF8String:e.what()],
+                                                }];
+        }
+        return false;
+    }
 
     if(serialSize != length)
     {
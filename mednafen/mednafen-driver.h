@@ -185,6 +185,20 @@ void MDFNI_ToggleDIPView(void);
 
 bool MDFNI_EnableStateRewind(bool enable);
 
+// Cumulative run-ahead("runahead" setting) statistics since game load; divide by "count" for per-frame averages.
+struct MDFN_RunAheadStats
+{
+ uint64 count = 0;		// Number of MDFNI_Emulate() calls that used run-ahead.
+ uint64 ahead_frames = 0;	// Total number of frames emulated ahead.
+ uint64 real_us = 0;		// Time spent emulating the real frames.
+ uint64 save_us = 0;		// Time spent saving state.
+ uint64 ahead_us = 0;		// Time spent emulating ahead.
+ uint64 load_us = 0;		// Time spent loading state.
+ uint64 state_size = 0;		// Size of the most recent run-ahead state, in bytes.
+};
+void MDFNI_GetRunAheadStats(MDFN_RunAheadStats* stats);
+uint32 MDFNI_SeekStateRewind(uint32 count);
+
 bool MDFNI_StartAVRecord(const char *path, double SoundRate) MDFN_COLD;
 void MDFNI_StopAVRecord(void) MDFN_COLD;
 
@@ -106,6 +106,9 @@ static const MDFNSetting MednafenSettings[] =
 
   { "srwframes", MDFNSF_NOFLAGS, gettext_noop("Number of frames to keep states for when state rewinding is enabled."), 
 	gettext_noop("Caution: Setting this to a large value may cause excessive RAM usage in some circumstances, such as with games that stream large volumes of data off of CDs."), MDFNST_UINT, "600", "10", "99999" },
+  { "srwmemory", MDFNSF_NOFLAGS, gettext_noop("Maximum memory, in bytes, to use for compressed states when state rewinding is enabled."), gettext_noop("When nonzero, the oldest states are discarded as needed to stay within this budget, in addition to the \"srwframes\" limit.  0 disables the budget."), MDFNST_UINT, "0", "0", "0xFFFFFFFF" },
+  { "srwkeyframes", MDFNSF_NOFLAGS, gettext_noop("Interval, in frames, between full keyframes in the state rewind buffer."), gettext_noop("Bounds the number of delta decodes needed to seek to an arbitrary point in the rewind history, at the cost of some compression ratio.  Set to 0 to store only deltas."), MDFNST_UINT, "60", "0", "99999" },
+  { "srwthread", MDFNSF_NOFLAGS, gettext_noop("Compress rewind states in a separate thread."), gettext_noop("Moves the XOR filtering and compression of rewind states off of the emulation thread, at the cost of a small amount of extra memory for queued states."), MDFNST_BOOL, "0" },
 
   { "cd.image_memcache", MDFNSF_NOFLAGS, gettext_noop("Cache entire CD images in memory."), gettext_noop("Reads the entire CD image(s) into memory at startup(which will cause a small delay).  Can help obviate emulation hiccups due to emulated CD access.  May cause more harm than good on low memory systems, systems with swap enabled, and/or when the disc images in question are on a fast SSD.\n\nCaution: When using a 32-bit build of Mednafen on Windows or a 32-bit operating system, Mednafen may run out of address space(and error out, possibly in the middle of emulation) if this option is enabled when loading large disc sets(e.g. 3+ discs) via M3U files."), MDFNST_BOOL, "0" },
   { "cd.m3u.recursion_limit", MDFNSF_NOFLAGS, gettext_noop("M3U recursion limit."), gettext_noop("A value of 0 effectively disables recursive loading of M3U files."), MDFNST_UINT, "9", "0", "99" },
@@ -141,6 +144,8 @@ static const MDFNSetting MednafenSettings[] =
 
   { "video.deinterlacer", MDFNSF_CAT_VIDEO, gettext_noop("Deinterlacer to use for interlaced video."), NULL, MDFNST_ENUM, "weave", NULL, NULL, NULL, SettingChanged, Deinterlacer_List },
 
+  { "runahead", MDFNSF_NOFLAGS, gettext_noop("Number of frames to run ahead to reduce input latency."), gettext_noop("Each frame, the real frame is emulated with video disabled, a state is saved, this many frames are emulated ahead with sound discarded(and video disabled for all but the last), and the state is loaded back; the last frame's video is shown.  Requires save state support, and is disabled during netplay and state rewinding.  CPU usage is multiplied accordingly, see MDFNI_GetRunAheadStats() for per-frame costs."), MDFNST_UINT, "0", "0", "8", NULL, SettingChanged },
+
   { "affinity.cd", MDFNSF_NOFLAGS, gettext_noop("CD read threads CPU affinity mask."), gettext_noop("Set to 0 to disable changing affinity."), MDFNST_UINT, "0", "0x0000000000000000", "0xFFFFFFFFFFFFFFFF" },
 
   { NULL }
@@ -289,6 +294,12 @@ static std::unique_ptr<Deinterlacer> deint;
 
 static bool FFDiscard = false; // TODO:  Setting to discard sound samples instead of increasing pitch
 
+static unsigned RunAheadFrames;
+static bool InRunAhead;
+static std::unique_ptr<MemoryStream> RunAheadState;
+static std::vector<int16> RunAheadSoundBuf;
+static MDFN_RunAheadStats RunAheadStats;
+
 static std::vector<CDInterface *> CDInterfaces;
 
 struct DriveMediaStatus
@@ -309,6 +320,8 @@ static void SettingChanged(const char* name)
   deint.reset(nullptr);
   deint.reset(Deinterlacer::Create(MDFN_GetSettingUI(name)));
  }
+ else if(!strcmp(name, "runahead"))
+  RunAheadFrames = MDFN_GetSettingUI(name);
 }
 
 bool MDFNI_StartWAVRecord(const char *path, double SoundRate)
@@ -399,6 +412,10 @@ void MDFNI_StopWAVRecord(void)
 
 static MDFN_COLD void Cleanup(void)
 {
+ RunAheadState.reset(nullptr);
+ RunAheadSoundBuf.clear();
+ RunAheadSoundBuf.shrink_to_fit();
+
  MDFNSRW_End();
  MDFNMOV_Stop();
  MDFNMP_Kill();
@@ -1002,6 +1019,9 @@ static MDFN_COLD void LoadCommonPost(const std::string& fbase_name, GameFile* gf
 	PrevInterlaced = false;
 	SettingChanged("video.deinterlacer");
 
+	SettingChanged("runahead");
+	RunAheadStats = MDFN_RunAheadStats();
+
 	if(MDFN_GetSettingB(std::string(MDFNGameInfo->shortname) + ".tblur"))
 	{
 	 const bool accum_mode = MDFN_GetSettingB(std::string(MDFNGameInfo->shortname) + ".tblur.accum");
@@ -1847,6 +1867,10 @@ static void ProcessAudio(EmulateSpecStruct *espec)
 
 void MDFN_MidSync(EmulateSpecStruct *espec, const unsigned flags)
 {
+ // Run-ahead frames are discarded, so their sound must not be output, and they must see the same input as the real frame.
+ if(InRunAhead)
+  return;
+
  ProcessAudio(espec);
  espec->SoundBufSize_InternalProcessed = espec->SoundBufSize;
  espec->MasterCycles_InternalProcessed = espec->MasterCycles;
@@ -1874,6 +1898,100 @@ void MDFN_MidLineUpdate(EmulateSpecStruct *espec, int y)
  //MDFND_MidLineUpdate(espec, y);
 }
 
+//
+// Emulate the real frame with video disabled and sound output as usual, save state, emulate RunAheadFrames frames ahead with
+// the same input and sound discarded(video enabled only on the last), and then load the state back, leaving the espec with the
+// predicted frame's video and the real frame's sound.
+//
+// The real frame is emulated first so that the sound output never comes from emulation that is later undone by a state load.
+// (Mednafen emulation modules keep their state in globals, so running the prediction in a second emulator instance isn't possible.)
+//
+static void EmulateRunAhead(EmulateSpecStruct* espec)
+{
+ const int skip_save = espec->skip;
+ int64 t[5];
+
+ t[0] = Time::MonoUS();
+ espec->skip = true;
+ MDFNGameInfo->Emulate(espec);
+ t[1] = Time::MonoUS();
+
+ if(!RunAheadState)
+  RunAheadState.reset(new MemoryStream(65536));
+
+ RunAheadState->rewind();
+ RunAheadState->truncate(0);
+ MDFNSS_SaveInternal(RunAheadState.get(), MDFN_StateAction);
+ t[2] = Time::MonoUS();
+ //
+ //
+ //
+ int16* const SoundBuf_save = espec->SoundBuf;
+ const int32 SoundBufSize_save = espec->SoundBufSize;
+ const int32 SoundBufSize_InternalProcessed_save = espec->SoundBufSize_InternalProcessed;
+ const int64 MasterCycles_save = espec->MasterCycles;
+ const int64 MasterCycles_InternalProcessed_save = espec->MasterCycles_InternalProcessed;
+ const double SoundVolume_save = espec->SoundVolume;
+ const double soundmultiplier_save = espec->soundmultiplier;
+
+ if(espec->SoundBuf)
+ {
+  RunAheadSoundBuf.resize(espec->SoundBufMaxSize * MDFNGameInfo->soundchan);
+  espec->SoundBuf = RunAheadSoundBuf.data();
+ }
+
+ InRunAhead = true;
+ try
+ {
+  for(unsigned i = 0; i < RunAheadFrames; i++)
+  {
+   espec->skip = ((i + 1) < RunAheadFrames) ? true : skip_save;
+   espec->SoundBufSize = 0;
+   espec->SoundBufSize_InternalProcessed = 0;
+   espec->MasterCycles = 0;
+   espec->MasterCycles_InternalProcessed = 0;
+   espec->SoundVolume = SoundVolume_save;
+   espec->soundmultiplier = soundmultiplier_save;
+
+   MDFNGameInfo->Emulate(espec);
+  }
+ }
+ catch(...)
+ {
+  InRunAhead = false;
+  throw;
+ }
+ InRunAhead = false;
+ t[3] = Time::MonoUS();
+
+ espec->SoundBuf = SoundBuf_save;
+ espec->SoundBufSize = SoundBufSize_save;
+ espec->SoundBufSize_InternalProcessed = SoundBufSize_InternalProcessed_save;
+ espec->MasterCycles = MasterCycles_save;
+ espec->MasterCycles_InternalProcessed = MasterCycles_InternalProcessed_save;
+ espec->SoundVolume = SoundVolume_save;
+ espec->soundmultiplier = soundmultiplier_save;
+ //
+ //
+ //
+ RunAheadState->rewind();
+ MDFNSS_LoadInternal(RunAheadState.get(), MDFN_StateAction);
+ t[4] = Time::MonoUS();
+
+ RunAheadStats.count++;
+ RunAheadStats.ahead_frames += RunAheadFrames;
+ RunAheadStats.real_us += t[1] - t[0];
+ RunAheadStats.save_us += t[2] - t[1];
+ RunAheadStats.ahead_us += t[3] - t[2];
+ RunAheadStats.load_us += t[4] - t[3];
+ RunAheadStats.state_size = RunAheadState->size();
+}
+
+void MDFNI_GetRunAheadStats(MDFN_RunAheadStats* stats)
+{
+ *stats = RunAheadStats;
+}
+
 void MDFNI_Emulate(EmulateSpecStruct *espec)
 {
 #if 0
@@ -1959,7 +2077,10 @@ void MDFNI_Emulate(EmulateSpecStruct *espec)
  else
   espec->NeedSoundReverse = MDFNSRW_Frame(espec->NeedRewind);
 
- MDFNGameInfo->Emulate(espec);
+ if(RunAheadFrames && !MDFNnetplay && !espec->NeedRewind && MDFNGameInfo->StateAction)
+  EmulateRunAhead(espec);
+ else
+  MDFNGameInfo->Emulate(espec);
 
  if(MDFNnetplay)
   Netplay_PostProcess(PortDevice, PortData, PortDataLen);
@@ -25,6 +25,10 @@
 
 #include "psx.h"
 #include "timer.h"
+#include <mednafen/Time.h>
+#include <mednafen/MThreading.h>
+
+#include <atomic>
 
 /* FIXME: Respect horizontal timing register values in relation to hsync/hblank/hretrace/whatever signal sent to the timers */
 
@@ -69,6 +73,7 @@ namespace MDFN_IEN_PSX
 {
 
 PS_GPU GPU;
+PS_GPU GPU_RT;
 
 namespace PS_GPU_INTERNAL
 {
@@ -76,7 +81,338 @@ namespace PS_GPU_INTERNAL
 }
 using namespace PS_GPU_INTERNAL;
 
-void GPU_Init(bool pal_clock_and_tv)
+// Fills in drawing command table entries 0x20-0x7F for the render thread and for timing-only execution on the emulation thread(gpu_mt.cpp).
+MDFN_HIDE void GPU_GetMTCommands(CTEntry* rt_commands, CTEntry* to_commands);
+
+//
+// Render thread.  Polygon, sprite, and line commands are still run on the emulation thread, but with all pixel work stripped
+// out(just enough is left to keep DrawTimeAvail exact), and are queued up to be drawn into GPURAM for real on the render thread.
+// Anything else that touches GPURAM waits for the queue to drain first, via GPU_SyncRender().
+//
+static MThreading::Thread* RThread = NULL;
+static MThreading::Sem* RWakeupSem = NULL;
+
+enum
+{
+ RCOMMAND_DRAW = 0,
+ RCOMMAND_SET_STATE,
+ RCOMMAND_INVALIDATE_TEXCACHE,
+ RCOMMAND_INVALIDATE_CACHE,
+ RCOMMAND_EXIT
+};
+
+// Subset of the drawing state that the drawing code reads, besides the caches.
+struct RenderState
+{
+ decltype(PS_GPU::SUCV) SUCV;
+
+ int32 ClipX0;
+ int32 ClipY0;
+ int32 ClipX1;
+ int32 ClipY1;
+
+ int32 OffsX;
+ int32 OffsY;
+
+ uint32 MaskSetOR;
+ uint32 SpriteFlip;
+
+ uint32 DisplayFB_YStart;
+ uint32 DisplayMode;
+
+ bool dtd;
+ bool dfe;
+ bool field_ram_readout;
+ uint8 InCmd;
+};
+
+struct RQ_Entry
+{
+ uint32 Command;
+ void (*func)(const uint32 *cb);
+
+ union
+ {
+  uint32 CB[0x10];
+  RenderState State;
+ };
+};
+
+static std::array<RQ_Entry, 0x1000> RQ;
+static size_t RQ_ReadPos, RQ_WritePos;
+static std::atomic_uint_least32_t RQ_InCount;
+static RenderState RQ_LastState;
+static bool RQ_LastStateValid;
+
+static INLINE RQ_Entry* RQ_Alloc(const uint32 command)
+{
+ while(MDFN_UNLIKELY(RQ_InCount.load(std::memory_order_acquire) == RQ.size()))
+  Time::SleepMS(1);
+
+ RQ_Entry* rqe = &RQ[RQ_WritePos];
+
+ rqe->Command = command;
+
+ return rqe;
+}
+
+static INLINE void RQ_Commit(void)
+{
+ RQ_WritePos = (RQ_WritePos + 1) % RQ.size();
+
+ if(!RQ_InCount.fetch_add(1, std::memory_order_release))
+  MThreading::Sem_Post(RWakeupSem);
+}
+
+static int RThreadEntry(void* data)
+{
+ bool Running = true;
+
+ while(MDFN_LIKELY(Running))
+ {
+  while(MDFN_UNLIKELY(RQ_InCount.load(std::memory_order_acquire) == 0))
+   MThreading::Sem_TimedWait(RWakeupSem, 1);
+  //
+  //
+  //
+  RQ_Entry* rqe = &RQ[RQ_ReadPos];
+
+  switch(rqe->Command)
+  {
+   case RCOMMAND_DRAW:
+	rqe->func(rqe->CB);
+	break;
+
+   case RCOMMAND_SET_STATE:
+	{
+	 const RenderState& s = rqe->State;
+
+	 GPU_RT.SUCV = s.SUCV;
+	 GPU_RT.ClipX0 = s.ClipX0;
+	 GPU_RT.ClipY0 = s.ClipY0;
+	 GPU_RT.ClipX1 = s.ClipX1;
+	 GPU_RT.ClipY1 = s.ClipY1;
+	 GPU_RT.OffsX = s.OffsX;
+	 GPU_RT.OffsY = s.OffsY;
+	 GPU_RT.MaskSetOR = s.MaskSetOR;
+	 GPU_RT.SpriteFlip = s.SpriteFlip;
+	 GPU_RT.DisplayFB_YStart = s.DisplayFB_YStart;
+	 GPU_RT.DisplayMode = s.DisplayMode;
+	 GPU_RT.dtd = s.dtd;
+	 GPU_RT.dfe = s.dfe;
+	 GPU_RT.field_ram_readout = s.field_ram_readout;
+	 GPU_RT.InCmd = s.InCmd;
+	}
+	break;
+
+   case RCOMMAND_INVALIDATE_CACHE:
+	GPU_RT.CLUT_Cache_VB = ~0U;
+	// Fall through
+
+   case RCOMMAND_INVALIDATE_TEXCACHE:
+	for(auto& c : GPU_RT.TexCache)
+	 c.Tag = ~0U;
+	break;
+
+   case RCOMMAND_EXIT:
+	Running = false;
+	break;
+  }
+  //
+  //
+  //
+  RQ_ReadPos = (RQ_ReadPos + 1) % RQ.size();
+  RQ_InCount.fetch_sub(1, std::memory_order_release);
+ }
+
+ return 0;
+}
+
+void GPU_SyncRender(void)
+{
+ if(!RThread)
+  return;
+
+ while(MDFN_UNLIKELY(RQ_InCount.load(std::memory_order_acquire) != 0))
+ {
+  //Time::SleepMS(1);
+ }
+}
+
+//
+// Call with the render thread idle(after GPU_SyncRender()), to bring its copy of the drawing state and caches in line with
+// the emulation thread's after a power-on or state load.
+//
+static void ResyncRender(void)
+{
+ if(!RThread)
+  return;
+
+ memcpy(GPU_RT.CLUT_Cache, CLUT_Cache, sizeof(CLUT_Cache));
+ GPU_RT.CLUT_Cache_VB = CLUT_Cache_VB;
+ memcpy(GPU_RT.TexCache, TexCache, sizeof(TexCache));
+ memcpy(GPU_RT.InQuad_F3Vertices, InQuad_F3Vertices, sizeof(InQuad_F3Vertices));
+ GPU_RT.InPLine_PrevPoint = InPLine_PrevPoint;
+
+ RQ_LastStateValid = false;
+}
+
+//
+// Band workers, run from the render thread.  Worker 0 is the render thread itself.
+//
+struct BandWorker
+{
+ MThreading::Thread* Thread;
+ MThreading::Sem* StartSem;
+ MThreading::Sem* DoneSem;
+ uint32 SpanBegin;
+ uint32 SpanEnd;
+ PS_GPU::TexCacheEntry TexCache[256];
+};
+
+unsigned GPU_RTBandCount = 0;
+static BandWorker* BandWorkers = NULL;
+static void (*BandFunc)(const void* data, PS_GPU::TexCacheEntry* tc, uint32 span_begin, uint32 span_end);
+static const void* BandData;
+
+static int BandThreadEntry(void* data)
+{
+ BandWorker* bw = (BandWorker*)data;
+
+ for(;;)
+ {
+  MThreading::Sem_Wait(bw->StartSem);
+
+  if(!BandFunc)
+   break;
+
+  BandFunc(BandData, bw->TexCache, bw->SpanBegin, bw->SpanEnd);
+  MThreading::Sem_Post(bw->DoneSem);
+ }
+
+ return 0;
+}
+
+void GPU_RTDrawBands(void (*func)(const void* data, PS_GPU::TexCacheEntry* tc, uint32 span_begin, uint32 span_end), const void* data, uint32 span_count)
+{
+ BandFunc = func;
+ BandData = data;
+
+ for(unsigned i = 0; i < GPU_RTBandCount; i++)
+ {
+  BandWorker* bw = &BandWorkers[i];
+
+  bw->SpanBegin = (uint64)span_count * i / GPU_RTBandCount;
+  bw->SpanEnd = (uint64)span_count * (i + 1) / GPU_RTBandCount;
+
+  for(auto& c : bw->TexCache)
+   c.Tag = ~0U;
+
+  if(i)
+   MThreading::Sem_Post(bw->StartSem);
+ }
+
+ func(data, BandWorkers[0].TexCache, BandWorkers[0].SpanBegin, BandWorkers[0].SpanEnd);
+
+ for(unsigned i = 1; i < GPU_RTBandCount; i++)
+  MThreading::Sem_Wait(BandWorkers[i].DoneSem);
+
+ //
+ // The last band, in drawing order, to have used a cache entry determines its final state.
+ //
+ for(unsigned ce = 0; ce < 256; ce++)
+ {
+  for(unsigned i = GPU_RTBandCount; i; i--)
+  {
+   const PS_GPU::TexCacheEntry& c = BandWorkers[i - 1].TexCache[ce];
+
+   if(c.Tag != ~0U)
+   {
+    GPU_RT.TexCache[ce] = c;
+    break;
+   }
+  }
+ }
+}
+
+static void KillBandWorkers(void)
+{
+ if(BandWorkers)
+ {
+  BandFunc = NULL;
+
+  for(unsigned i = 1; i < GPU_RTBandCount; i++)
+  {
+   BandWorker* bw = &BandWorkers[i];
+
+   if(bw->Thread)
+   {
+    MThreading::Sem_Post(bw->StartSem);
+    MThreading::Thread_Wait(bw->Thread, NULL);
+   }
+
+   if(bw->StartSem)
+    MThreading::Sem_Destroy(bw->StartSem);
+
+   if(bw->DoneSem)
+    MThreading::Sem_Destroy(bw->DoneSem);
+  }
+
+  delete[] BandWorkers;
+  BandWorkers = NULL;
+ }
+
+ GPU_RTBandCount = 0;
+}
+
+static INLINE void QueueDraw(void (*func)(const uint32 *cb), const uint32* CB, const unsigned len)
+{
+ RenderState s;
+
+ memset(&s, 0, sizeof(s));	// For memcmp()
+ s.SUCV = SUCV;
+ s.ClipX0 = ClipX0;
+ s.ClipY0 = ClipY0;
+ s.ClipX1 = ClipX1;
+ s.ClipY1 = ClipY1;
+ s.OffsX = OffsX;
+ s.OffsY = OffsY;
+ s.MaskSetOR = MaskSetOR;
+ s.SpriteFlip = SpriteFlip;
+ s.DisplayFB_YStart = DisplayFB_YStart;
+ s.DisplayMode = DisplayMode;
+ s.dtd = dtd;
+ s.dfe = dfe;
+ s.field_ram_readout = field_ram_readout;
+ s.InCmd = InCmd;
+
+ if(!RQ_LastStateValid || memcmp(&s, &RQ_LastState, sizeof(s)))
+ {
+  RQ_Alloc(RCOMMAND_SET_STATE)->State = s;
+  RQ_Commit();
+
+  RQ_LastState = s;
+  RQ_LastStateValid = true;
+ }
+
+ RQ_Entry* rqe = RQ_Alloc(RCOMMAND_DRAW);
+
+ rqe->func = func;
+ memcpy(rqe->CB, CB, len * sizeof(uint32));
+ RQ_Commit();
+}
+
+static INLINE void DoCommand(const uint32 cc, const uint32* CB, const unsigned len)
+{
+ const unsigned fi = TexMode | (MaskEvalAND ? 0x4 : 0x0);
+
+ if(RThread && cc >= 0x20 && cc < 0x80)
+  QueueDraw(GPU_RT.Commands[cc].func[abr][fi], CB, len);
+
+ Commands[cc].func[abr][fi](CB);
+}
+
+void GPU_Init(bool pal_clock_and_tv, bool render_thread, uint64 affinity, unsigned bands)
 {
  static const int8 dither_table[4][4] =
  {
@@ -124,11 +460,55 @@ void GPU_Init(bool pal_clock_and_tv)
  memcpy(&Commands[0x40], Commands_40_5F, sizeof(Commands_40_5F));
  memcpy(&Commands[0x60], Commands_60_7F, sizeof(Commands_60_7F));
  memcpy(&Commands[0x80], Commands_80_FF, sizeof(Commands_80_FF));
+
+ if(render_thread)
+ {
+  GPU_GetMTCommands(GPU_RT.Commands, Commands);
+  //
+  RQ_ReadPos = 0;
+  RQ_WritePos = 0;
+  RQ_InCount.store(0, std::memory_order_release);
+  RQ_LastStateValid = false;
+
+  if(bands > 1)
+  {
+   BandWorkers = new BandWorker[bands]();
+   GPU_RTBandCount = bands;
+
+   for(unsigned i = 1; i < bands; i++)
+   {
+    BandWorker* bw = &BandWorkers[i];
+
+    bw->StartSem = MThreading::Sem_Create();
+    bw->DoneSem = MThreading::Sem_Create();
+    bw->Thread = MThreading::Thread_Create(BandThreadEntry, bw, "MDFN PSX GPU Band");
+   }
+  }
+
+  RWakeupSem = MThreading::Sem_Create();
+  RThread = MThreading::Thread_Create(RThreadEntry, NULL, "MDFN PSX GPU Render");
+  if(affinity)
+   MThreading::Thread_SetAffinity(RThread, affinity);
+ }
 }
 
 void GPU_Kill(void)
 {
+ if(RThread != NULL)
+ {
+  RQ_Alloc(RCOMMAND_EXIT);
+  RQ_Commit();
+  MThreading::Thread_Wait(RThread, NULL);
+  RThread = NULL;
+ }
+
+ KillBandWorkers();
 
+ if(RWakeupSem != NULL)
+ {
+  MThreading::Sem_Destroy(RWakeupSem);
+  RWakeupSem = NULL;
+ }
 }
 
 /*
@@ -214,13 +594,26 @@ static INLINE void InvalidateTexCache(void)
 {
  for(auto& c : TexCache)
   c.Tag = ~0U;
+
+ if(RThread)
+ {
+  RQ_Alloc(RCOMMAND_INVALIDATE_TEXCACHE);
+  RQ_Commit();
+ }
 }
 
 static void InvalidateCache(void)
 {
  CLUT_Cache_VB = ~0U;
 
- InvalidateTexCache();
+ for(auto& c : TexCache)
+  c.Tag = ~0U;
+
+ if(RThread)
+ {
+  RQ_Alloc(RCOMMAND_INVALIDATE_CACHE);
+  RQ_Commit();
+ }
 }
 
 static void SoftReset(void) // Control command 0x00
@@ -293,6 +686,8 @@ static void SoftReset(void) // Control command 0x00
 
 void GPU_Power(void)
 {
+ GPU_SyncRender();
+
  memset(GPURAM, 0, sizeof(GPURAM));
 
  memset(CLUT_Cache, 0, sizeof(CLUT_Cache));
@@ -387,6 +782,9 @@ void GPU_Power(void)
 
  SoftReset();
 
+ GPU_SyncRender();
+ ResyncRender();
+
  IRQ_Assert(IRQ_VBLANK, InVBlank);
  TIMER_SetVBlank(InVBlank);
 }
@@ -410,6 +808,8 @@ static void Command_FBFill(const uint32 *cb)
  int32 width =  (((cb[2] >> 0) & 0x3FF) + 0xF) & ~0xF;
  int32 height = (cb[2] >> 16) & 0x1FF;
 
+ GPU_SyncRender();
+
  //printf("[GPU] FB Fill %d:%d w=%d, h=%d\n", destX, destY, width, height);
  DrawTimeAvail -= 46;	// Approximate
 
@@ -447,6 +847,7 @@ static void Command_FBCopy(const uint32 *cb)
  if(!height)
   height = 0x200;
 
+ GPU_SyncRender();
  InvalidateTexCache();
  //printf("FB Copy: %d %d %d %d %d %d\n", sourceX, sourceY, destX, destY, width, height);
 
@@ -483,6 +884,8 @@ static void Command_FBWrite(const uint32 *cb)
 {
  assert(InCmd == PS_GPU::INCMD_NONE);
 
+ GPU_SyncRender();
+
  FBRW_X = (cb[1] >>  0) & 0x3FF;
  FBRW_Y = (cb[1] >> 16) & 0x3FF;
 
@@ -512,6 +915,8 @@ static void Command_FBRead(const uint32 *cb)
 {
  assert(InCmd == PS_GPU::INCMD_NONE);
 
+ GPU_SyncRender();
+
  FBRW_X = (cb[1] >>  0) & 0x3FF;
  FBRW_Y = (cb[1] >> 16) & 0x3FF;
 
@@ -739,7 +1144,6 @@ static void ProcessFIFO(void)
 	 return;
 
 	const uint32 cc = InCmd_CC;
-	const CTEntry *command = &Commands[cc];
 	unsigned vl = 1 + (bool)(cc & 0x4) + (bool)(cc & 0x10);
 	uint32 CB[3];
 
@@ -750,7 +1154,7 @@ static void ProcessFIFO(void)
 	  CB[i] = BlitterFIFO.Read();
 	 }
 
-	 command->func[abr][TexMode | (MaskEvalAND ? 0x4 : 0x0)](CB);
+	 DoCommand(cc, CB, vl);
 	}
 	return;
        }
@@ -762,7 +1166,6 @@ static void ProcessFIFO(void)
 	 return;
 
 	const uint32 cc = InCmd_CC;
-	const CTEntry *command = &Commands[cc];
 	unsigned vl = 1 + (bool)(InCmd_CC & 0x10);
 	uint32 CB[2];
 
@@ -780,7 +1183,7 @@ static void ProcessFIFO(void)
 	  CB[i] = BlitterFIFO.Read();
 	 }
 
-	 command->func[abr][TexMode | (MaskEvalAND ? 0x4 : 0x0)](CB);
+	 DoCommand(cc, CB, vl);
 	}
 	return;
        }
@@ -829,7 +1232,7 @@ static void ProcessFIFO(void)
   }
   else
   {
-   command->func[abr][TexMode | (MaskEvalAND ? 0x4 : 0x0)](CB);
+   DoCommand(cc, CB, command->len);
   }
  }
 }
@@ -1417,6 +1820,9 @@ MDFN_FASTCALL pscpu_timestamp_t GPU_Update(const pscpu_timestamp_t sys_timestamp
      {
       const uint16 *src = GPURAM[DisplayFB_CurLineYReadout];
 
+      if(dx_end > dx_start)
+       GPU_SyncRender();
+
       for(int32 x = 0; x < dx_start; x++)
        dest[x] = black;
 
@@ -1548,6 +1954,18 @@ void GPU_StateAction(StateMem *sm, const unsigned load, const bool data_only)
  uint32 TexCache_Tag[256];
  uint16 TexCache_Data[256][4];
 
+ //
+ // The emulation thread's caches only have valid tags when the render thread is in use; the render thread has
+ // the same tags, and the data to go with them.
+ //
+ GPU_SyncRender();
+
+ if(RThread && !load)
+ {
+  memcpy(CLUT_Cache, GPU_RT.CLUT_Cache, sizeof(CLUT_Cache));
+  memcpy(TexCache, GPU_RT.TexCache, sizeof(TexCache));
+ }
+
  for(unsigned i = 0; i < 256; i++)
  {
   TexCache_Tag[i] = TexCache[i].Tag;
@@ -1697,6 +2115,8 @@ void GPU_StateAction(StateMem *sm, const unsigned load, const bool data_only)
   OffsX = sign_x_to_s32(11, OffsX);
   OffsY = sign_x_to_s32(11, OffsY);
 
+  ResyncRender();
+
   IRQ_Assert(IRQ_GPU, IRQPending);
  }
 }
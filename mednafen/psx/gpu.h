@@ -66,7 +66,7 @@ struct PS_GPU
   uint32 TWY_ADD;
  } SUCV;
 
- struct
+ struct TexCacheEntry
  {
   uint16 Data[4];
   uint32 Tag;
@@ -211,8 +211,17 @@ struct PS_GPU
 };
 
  MDFN_HIDE extern PS_GPU GPU;
+ MDFN_HIDE extern PS_GPU GPU_RT;	// Drawing state as seen by the render thread; GPURAM is not used.
 
- void GPU_Init(bool pal_clock_and_tv) MDFN_COLD;
+ //
+ // For the render thread only: splits the spans of a large polygon into GPU_RTBandCount contiguous bands, and
+ // draws them in parallel, each with its own texture cache; GPU_RT.TexCache is then updated as if the spans had been
+ // drawn in order.
+ //
+ MDFN_HIDE extern unsigned GPU_RTBandCount;
+ void GPU_RTDrawBands(void (*func)(const void* data, PS_GPU::TexCacheEntry* tc, uint32 span_begin, uint32 span_end), const void* data, uint32 span_count);
+
+ void GPU_Init(bool pal_clock_and_tv, bool render_thread, uint64 affinity, unsigned bands) MDFN_COLD;
  void GPU_Kill(void) MDFN_COLD;
 
  void GPU_SetGetVideoParams(MDFNGI* gi, const bool caspect, const int sls, const int sle, const bool show_h_overscan) MDFN_COLD;
@@ -258,6 +267,10 @@ struct PS_GPU
 
  MDFN_FASTCALL uint32 GPU_Read(const pscpu_timestamp_t timestamp, uint32 A);
 
+ // Waits for the render thread to finish all queued drawing; must be called before touching GPURAM outside of
+ // the drawing code.
+ void GPU_SyncRender(void);
+
  static INLINE int32 GPU_GetScanlineNum(void)
  {
   return GPU.scanline;
@@ -265,11 +278,13 @@ struct PS_GPU
 
  static INLINE uint16 GPU_PeekRAM(uint32 A)
  {
+  GPU_SyncRender();
   return GPU.GPURAM[(A >> 10) & 0x1FF][A & 0x3FF];
  }
 
  static INLINE void GPU_PokeRAM(uint32 A, uint16 V)
  {
+  GPU_SyncRender();
   GPU.GPURAM[(A >> 10) & 0x1FF][A & 0x3FF] = V;
  }
 }
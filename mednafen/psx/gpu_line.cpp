@@ -146,6 +146,9 @@ static void DrawLine(line_point *points)
 
  DrawTimeAvail -= k * 2;
 
+ if(TimingOnly)
+  return;
+
  //
  //
  //
@@ -0,0 +1,73 @@
+/******************************************************************************/
+/* Mednafen Sony PS1 Emulation Module                                         */
+/******************************************************************************/
+/* gpu_mt.cpp:
+**  Copyright (C) 2011-2017 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+//
+// Extra builds of the drawing code for the render thread(see gpu_common.inc and gpu.cpp).  PS_GPU_INTERNAL is renamed for
+// each inclusion, as gpu_common.inc can only be included once per namespace.
+//
+// gpu_polygon.cpp goes last, so its GCC optimize pragma doesn't leak into the others.
+//
+
+#define PS_GPU_INTERNAL PS_GPU_INTERNAL_RT_LINE
+#define PSX_GPU_RENDER_SIDE 1
+#include "gpu_line.cpp"
+#undef PS_GPU_INTERNAL
+#define PS_GPU_INTERNAL PS_GPU_INTERNAL_RT_SPRITE
+#include "gpu_sprite.cpp"
+#undef PSX_GPU_RENDER_SIDE
+#undef PS_GPU_INTERNAL
+
+#define PS_GPU_INTERNAL PS_GPU_INTERNAL_TO_LINE
+#define PSX_GPU_TIMING_ONLY 1
+#include "gpu_line.cpp"
+#undef PS_GPU_INTERNAL
+#define PS_GPU_INTERNAL PS_GPU_INTERNAL_TO_SPRITE
+#include "gpu_sprite.cpp"
+#undef PSX_GPU_TIMING_ONLY
+#undef PS_GPU_INTERNAL
+
+#define PS_GPU_INTERNAL PS_GPU_INTERNAL_RT_POLYGON
+#define PSX_GPU_RENDER_SIDE 1
+#include "gpu_polygon.cpp"
+#undef PSX_GPU_RENDER_SIDE
+#undef PS_GPU_INTERNAL
+
+#define PS_GPU_INTERNAL PS_GPU_INTERNAL_TO_POLYGON
+#define PSX_GPU_TIMING_ONLY 1
+#include "gpu_polygon.cpp"
+#undef PSX_GPU_TIMING_ONLY
+#undef PS_GPU_INTERNAL
+
+namespace MDFN_IEN_PSX
+{
+
+void GPU_GetMTCommands(CTEntry* rt_commands, CTEntry* to_commands)
+{
+ memcpy(&rt_commands[0x20], PS_GPU_INTERNAL_RT_POLYGON::Commands_20_3F, sizeof(PS_GPU_INTERNAL_RT_POLYGON::Commands_20_3F));
+ memcpy(&rt_commands[0x40], PS_GPU_INTERNAL_RT_LINE::Commands_40_5F, sizeof(PS_GPU_INTERNAL_RT_LINE::Commands_40_5F));
+ memcpy(&rt_commands[0x60], PS_GPU_INTERNAL_RT_SPRITE::Commands_60_7F, sizeof(PS_GPU_INTERNAL_RT_SPRITE::Commands_60_7F));
+
+ memcpy(&to_commands[0x20], PS_GPU_INTERNAL_TO_POLYGON::Commands_20_3F, sizeof(PS_GPU_INTERNAL_TO_POLYGON::Commands_20_3F));
+ memcpy(&to_commands[0x40], PS_GPU_INTERNAL_TO_LINE::Commands_40_5F, sizeof(PS_GPU_INTERNAL_TO_LINE::Commands_40_5F));
+ memcpy(&to_commands[0x60], PS_GPU_INTERNAL_TO_SPRITE::Commands_60_7F, sizeof(PS_GPU_INTERNAL_TO_SPRITE::Commands_60_7F));
+}
+
+}
@@ -51,6 +51,23 @@ struct i_deltas
  uint32 dr_dy, dg_dy, db_dy;
 };
 
+struct tri_spans
+{
+ i_deltas idl;
+ i_group ig;
+
+ struct
+ {
+  uint64 x_coord[2];
+  uint64 x_step[2];
+
+  int32 y_coord;
+  int32 y_bound;
+
+  bool dec_mode;
+ } tripart[2];
+};
+
 static INLINE int64 MakePolyXFP(uint32 x)
 {
  return ((uint64)x << 32) + ((1ULL << 32) - (1 << 11));
@@ -146,7 +163,7 @@ static INLINE void AddIDeltas_DY(i_group &ig, const i_deltas &idl, uint32 count
 }
 
 template<bool goraud, bool textured, int BlendMode, bool TexMult, uint32 TexMode_TA, bool MaskEval_TA>
-static INLINE void DrawSpan(int y, const int32 x_start, const int32 x_bound, i_group ig, const i_deltas &idl)
+static INLINE void DrawSpan(PS_GPU::TexCacheEntry* tc, int y, const int32 x_start, const int32 x_bound, i_group ig, const i_deltas &idl)
 {
   if(LineSkipTest(y))
    return;
@@ -181,6 +198,9 @@ static INLINE void DrawSpan(int y, const int32 x_start, const int32 x_bound, i_g
   else
    DrawTimeAvail -= w;
 
+  if(TimingOnly && !textured)
+   return;
+
   do
   {
    const uint32 r = ig.r >> (COORD_FBS + COORD_POST_PADDING);
@@ -191,7 +211,7 @@ static INLINE void DrawSpan(int y, const int32 x_start, const int32 x_bound, i_g
 
    if(textured)
    {
-    uint16 fbw = GetTexel<TexMode_TA>(ig.u >> (COORD_FBS + COORD_POST_PADDING), ig.v >> (COORD_FBS + COORD_POST_PADDING));
+    uint16 fbw = GetTexel<TexMode_TA>(tc, ig.u >> (COORD_FBS + COORD_POST_PADDING), ig.v >> (COORD_FBS + COORD_POST_PADDING));
 
     if(fbw)
     {
@@ -236,10 +256,154 @@ static INLINE void DrawSpan(int y, const int32 x_start, const int32 x_bound, i_g
   } while(MDFN_LIKELY(--w > 0));
 }
 
+//
+// Draws the spans of a triangle set up by DrawTriangle(), skipping any outside of [span_begin, span_end) in drawing order.
+//
+template<bool goraud, bool textured, int BlendMode, bool TexMult, uint32 TexMode_TA, bool MaskEval_TA>
+static INLINE void DrawTriangleSpans(const tri_spans& ts, PS_GPU::TexCacheEntry* tc, const uint32 span_begin, const uint32 span_end)
+{
+ const i_deltas& idl = ts.idl;
+ const i_group& ig = ts.ig;
+ auto* tripart = ts.tripart;
+ uint32 span_index = 0;
+
+ for(unsigned i = 0; i < 2; i++) //2; i++)
+ {
+  int32 yi = tripart[i].y_coord;
+  int32 yb = tripart[i].y_bound;
+
+  uint64 lc = tripart[i].x_coord[0];
+  uint64 ls = tripart[i].x_step[0];
+
+  uint64 rc = tripart[i].x_coord[1];
+  uint64 rs = tripart[i].x_step[1];
+
+  if(tripart[i].dec_mode)
+  {
+   while(MDFN_LIKELY(yi > yb))
+   {
+    yi--;
+    lc -= ls;
+    rc -= rs;
+    //
+    //
+    //
+    int32 y = sign_x_to_s32(11, yi);
+
+    if(y < ClipY0)
+     break;
+
+    if(y > ClipY1)
+    {
+     DrawTimeAvail -= 2;
+     span_index++;
+     continue;
+    }
+
+    if(span_index >= span_begin)
+     DrawSpan<goraud, textured, BlendMode, TexMult, TexMode_TA, MaskEval_TA>(tc, yi, GetPolyXFP_Int(lc), GetPolyXFP_Int(rc), ig, idl);
+
+    if(++span_index >= span_end)
+     return;
+   }
+  }
+  else
+  {
+   while(MDFN_LIKELY(yi < yb))
+   {
+    int32 y = sign_x_to_s32(11, yi);
+
+    if(y > ClipY1)
+     break;
+
+    if(y < ClipY0)
+    {
+     DrawTimeAvail -= 2;
+     goto skipit;
+    }
+
+    if(span_index >= span_begin)
+     DrawSpan<goraud, textured, BlendMode, TexMult, TexMode_TA, MaskEval_TA>(tc, yi, GetPolyXFP_Int(lc), GetPolyXFP_Int(rc), ig, idl);
+
+    if((span_index + 1) >= span_end)
+     return;
+    //
+    //
+    //
+    skipit: ;
+    span_index++;
+    yi++;
+    lc += ls;
+    rc += rs;
+   }
+  }
+ }
+}
+
+#ifdef PSX_GPU_RENDER_SIDE
+template<bool goraud, bool textured, int BlendMode, bool TexMult, uint32 TexMode_TA, bool MaskEval_TA>
+static void DrawTriangleBand(const void* ts, PS_GPU::TexCacheEntry* tc, uint32 span_begin, uint32 span_end)
+{
+ DrawTriangleSpans<goraud, textured, BlendMode, TexMult, TexMode_TA, MaskEval_TA>(*(const tri_spans*)ts, tc, span_begin, span_end);
+}
+
+//
+// Splitting a triangle into bands of spans doesn't change what's drawn, as each span is on a different row of GPURAM, except
+// where texture cache hits would return stale data that a band worker, each starting with an empty cache, would instead fetch
+// fresh from GPURAM.  So only split textured triangles when the texture cache is coherent with GPURAM to begin with, and
+// can't be made incoherent by the triangle itself.
+//
+template<bool textured, uint32 TexMode_TA>
+static INLINE bool CanDrawBands(const int32 y_top, const int32 y_bottom)
+{
+ if(!textured)
+  return true;
+
+ if(y_top < -1024 || y_bottom > 1024)
+  return false;
+
+ //
+ // Rows and columns of GPURAM that may be drawn to...
+ //
+ const int32 dy0 = std::max<int32>(y_top, ClipY0);
+ const int32 dy1 = std::min<int32>(y_bottom - 1, ClipY1);
+
+ if(dy0 > dy1)
+  return true;
+
+ const bool dy_wraps = (dy0 >> 9) != (dy1 >> 9);
+ const int32 dx0 = ClipX0;
+ const int32 dx1 = ClipX1;
+
+ //
+ // ...and texture fetched from.
+ //
+ const uint32 ty0 = SUCV.TWY_ADD;
+ const uint32 ty1 = std::min<uint32>(511, SUCV.TWY_ADD + 255);
+ const uint32 tx0 = SUCV.TWX_ADD >> (2 - TexMode_TA);
+ const uint32 tx1 = (SUCV.TWX_ADD + 255) >> (2 - TexMode_TA);
+
+ if(tx1 > 1023)
+  return false;
+
+ if((int32)tx0 <= dx1 && (int32)tx1 >= dx0 && (dy_wraps || ((int32)ty0 <= (dy1 & 511) && (int32)ty1 >= (dy0 & 511))))
+  return false;
+
+ for(auto const& c : TexCache)
+ {
+  if(c.Tag != ~0U && memcmp(c.Data, (uint16*)GPURAM + c.Tag, sizeof(c.Data)))
+   return false;
+ }
+
+ return true;
+}
+#endif
+
 template<bool goraud, bool textured, int BlendMode, bool TexMult, uint32 TexMode_TA, bool MaskEval_TA>
 static INLINE void DrawTriangle(tri_vertex *vertices)
 {
- i_deltas idl;
+ tri_spans ts;
+ i_deltas& idl = ts.idl;
  unsigned core_vertex;
 
  //
@@ -314,7 +478,7 @@ static INLINE void DrawTriangle(tri_vertex *vertices)
  int64 bound_coord_ls;
 
  bool right_facing;
- i_group ig;
+ i_group& ig = ts.ig;
 
  if(textured)
  {
@@ -364,16 +528,7 @@ static INLINE void DrawTriangle(tri_vertex *vertices)
  // core_vertex == 2:
  //	Left(base): vertices[2] -> (?vertices[1]?) -> vertices[0]
  //printf("%d %d\n", core_vertex, right_facing);
- struct
- {
-  uint64 x_coord[2];
-  uint64 x_step[2];
-
-  int32 y_coord;
-  int32 y_bound;
-
-  bool dec_mode;
- } tripart[2];
+ auto* tripart = ts.tripart;
 
 #if 0
  switch(core_vertex)
@@ -434,67 +589,23 @@ static INLINE void DrawTriangle(tri_vertex *vertices)
   tp->dec_mode = vp;
  }
 
- for(unsigned i = 0; i < 2; i++) //2; i++)
+ //
+ //
+ //
+#ifdef PSX_GPU_RENDER_SIDE
+ if(GPU_RTBandCount > 1)
  {
-  int32 yi = tripart[i].y_coord;
-  int32 yb = tripart[i].y_bound;
-
-  uint64 lc = tripart[i].x_coord[0];
-  uint64 ls = tripart[i].x_step[0];
+  const uint32 span_count = abs(tripart[0].y_bound - tripart[0].y_coord) + abs(tripart[1].y_bound - tripart[1].y_coord);
 
-  uint64 rc = tripart[i].x_coord[1];
-  uint64 rs = tripart[i].x_step[1];
-
-  if(tripart[i].dec_mode)
+  if(span_count >= GPU_RTBandCount * 16 && CanDrawBands<textured, TexMode_TA>(vertices[0].y, vertices[2].y))
   {
-   while(MDFN_LIKELY(yi > yb))
-   {
-    yi--;
-    lc -= ls;
-    rc -= rs;
-    //
-    //
-    //
-    int32 y = sign_x_to_s32(11, yi);
-
-    if(y < ClipY0)
-     break;
-
-    if(y > ClipY1)
-    {
-     DrawTimeAvail -= 2;
-     continue;
-    }
-
-    DrawSpan<goraud, textured, BlendMode, TexMult, TexMode_TA, MaskEval_TA>(yi, GetPolyXFP_Int(lc), GetPolyXFP_Int(rc), ig, idl);
-   }
-  }
-  else
-  {
-   while(MDFN_LIKELY(yi < yb))
-   {
-    int32 y = sign_x_to_s32(11, yi);
-
-    if(y > ClipY1)
-     break;
-
-    if(y < ClipY0)
-    {
-     DrawTimeAvail -= 2;
-     goto skipit;
-    }
-
-    DrawSpan<goraud, textured, BlendMode, TexMult, TexMode_TA, MaskEval_TA>(yi, GetPolyXFP_Int(lc), GetPolyXFP_Int(rc), ig, idl);
-    //
-    //
-    //
-    skipit: ;
-    yi++;
-    lc += ls;
-    rc += rs;
-   }
+   GPU_RTDrawBands(DrawTriangleBand<goraud, textured, BlendMode, TexMult, TexMode_TA, MaskEval_TA>, &ts, span_count);
+   return;
   }
  }
+#endif
+
+ DrawTriangleSpans<goraud, textured, BlendMode, TexMult, TexMode_TA, MaskEval_TA>(ts, TexCache, 0, ~0U);
 
 #if 0
  printf("[GPU] Vertices: %d:%d(r=%d, g=%d, b=%d) -> %d:%d(r=%d, g=%d, b=%d) -> %d:%d(r=%d, g=%d, b=%d)\n\n\n", vertices[0].x, vertices[0].y,
@@ -120,6 +120,9 @@ static void DrawSprite(int32 x_arg, int32 y_arg, int32 w, int32 h, uint8 u_arg,
     DrawTimeAvail -= suck_time;
    }
 
+   if(TimingOnly && !textured)
+    continue;
+
    for(int32 x = x_start; MDFN_LIKELY(x < x_bound); x++)
    {
     if(textured)
@@ -1684,7 +1684,7 @@ static MDFN_COLD void InitCommon(std::vector<CDInterface*> *CDInterfaces, const
 
  CPU = new PS_CPU();
  SPU = new PS_SPU();
- GPU_Init(region == REGION_EU);
+ GPU_Init(region == REGION_EU, MDFN_GetSettingB("psx.gpu_thread"), MDFN_GetSettingUI("psx.affinity.gpu"), MDFN_GetSettingUI("psx.gpu_bands"));
  CDC = new PS_CDC();
  FIO = new FrontIO();
 
@@ -2390,6 +2390,10 @@ static const MDFNSetting PSXSettings[] =
 
  { "psx.h_overscan", MDFNSF_NOFLAGS, gettext_noop("Show horizontal overscan area."), NULL, MDFNST_BOOL, "1" },
 
+ { "psx.gpu_thread", MDFNSF_NOFLAGS, gettext_noop("Draw polygons, sprites, and lines in a separate thread."), gettext_noop("Emulation is otherwise unchanged, including GPU timing, but the emulation thread will need to wait for the render thread at every GPU RAM access, including each scanline of display output, so the speedup on games that do little drawing per frame may be negligible."), MDFNST_BOOL, "0" },
+ { "psx.gpu_bands", MDFNSF_NOFLAGS, gettext_noop("Number of threads to split large polygons across."), gettext_noop("Polygons are split into horizontal bands drawn in parallel, with the same result as drawing them in one piece.  Only relevant when \"\5psx.gpu_thread\" is enabled; the render thread counts as one of these threads."), MDFNST_UINT, "1", "1", "8" },
+ { "psx.affinity.gpu", MDFNSF_NOFLAGS, gettext_noop("GPU rendering thread CPU affinity mask."), gettext_noop("Set to 0 to disable changing affinity.  Only relevant when \"\5psx.gpu_thread\" is enabled."), MDFNST_UINT, "0", "0x0000000000000000", "0xFFFFFFFFFFFFFFFF" },
+
 #if PSX_DBGPRINT_ENABLE
  { "psx.dbg_mask", MDFNSF_NOFLAGS, gettext_noop("Enable debug messages."), NULL, MDFNST_MULTI_ENUM, "none", NULL, NULL, NULL, NULL,  DBGMask_List },
 #endif
@@ -50,6 +50,7 @@ struct StateMem
  Stream* st = nullptr;
  bool svbe = false;	// State variable data is stored big-endian(for normal-path state loading only).
  int fuzz = MDFNSS_FUZZ_DISABLED;
+ StateDeltaContext* dctx = nullptr;	// For fast-path incremental saving/loading only.
 
  std::map<std::string, StateSectionMapEntry> secmap; // For loads
 
@@ -300,11 +301,152 @@ static void ReadStateChunk(Stream *st, const SFORMAT *sf, const char* sname, uin
  }
 }
 
+//
+// Incremental save/load of one large variable against its shadow copy in the StateDeltaContext.
+//
+enum : uint32 { DeltaChunkSize = 4096 };
+enum : uint32 { DeltaMinSize = 2 * DeltaChunkSize };
+
+enum : uint8
+{
+ DELTA_FULL = 0,
+ DELTA_CHUNKS = 1
+};
+
+template<bool load>
+static void DeltaRW(Stream* st, StateDeltaContext* dctx, uint8* p, const uint32 size)
+{
+ const uint32 num_chunks = (size + DeltaChunkSize - 1) / DeltaChunkSize;
+ const size_t bitmap_size = (num_chunks + 7) >> 3;
+ StateDeltaContext::Entry* e;
+
+ if(dctx->index == dctx->entries.size())
+  dctx->entries.emplace_back();
+
+ e = &dctx->entries[dctx->index++];
+
+ if(e->size != size)
+ {
+  e->shadow.reset(nullptr);
+  e->size = 0;
+ }
+
+ dctx->bitmap.resize(bitmap_size);
+ dctx->LastTotalBytes += size;
+
+ if(load)
+ {
+  const uint8 mode = st->get_u8();
+
+  if(mode == DELTA_FULL)
+  {
+   st->read(p, size);
+
+   if(!e->shadow)
+   {
+    e->shadow.reset(new uint8[size]);
+    e->size = size;
+   }
+   memcpy(e->shadow.get(), p, size);
+   dctx->LastChangedBytes += size;
+  }
+  else if(mode == DELTA_CHUNKS)
+  {
+   if(!e->shadow)
+    throw MDFN_Error(0, _("Incremental save state doesn't match the state delta context."));
+
+   st->read(dctx->bitmap.data(), bitmap_size);
+
+   for(uint32 c = 0; c < num_chunks; c++)
+   {
+    if(dctx->bitmap[c >> 3] & (1U << (c & 7)))
+    {
+     const uint32 offs = c * DeltaChunkSize;
+     const uint32 len = std::min<uint32>(DeltaChunkSize, size - offs);
+
+     st->read(e->shadow.get() + offs, len);
+     dctx->LastChangedBytes += len;
+    }
+   }
+
+   memcpy(p, e->shadow.get(), size);
+  }
+  else
+   throw MDFN_Error(0, _("Bad incremental save state variable mode 0x%02x."), mode);
+ }
+ else
+ {
+  if(!e->shadow)
+  {
+   e->shadow.reset(new uint8[size]);
+   e->size = size;
+   memcpy(e->shadow.get(), p, size);
+
+   st->put_u8(DELTA_FULL);
+   st->write(p, size);
+   dctx->LastChangedBytes += size;
+  }
+  else
+  {
+   //
+   // Compare and update the shadow copy first, then write out the bitmap followed by the changed chunks from the shadow copy.
+   //
+   memset(dctx->bitmap.data(), 0, bitmap_size);
+
+   for(uint32 c = 0; c < num_chunks; c++)
+   {
+    const uint32 offs = c * DeltaChunkSize;
+    const uint32 len = std::min<uint32>(DeltaChunkSize, size - offs);
+
+    if(memcmp(e->shadow.get() + offs, p + offs, len))
+    {
+     memcpy(e->shadow.get() + offs, p + offs, len);
+     dctx->bitmap[c >> 3] |= 1U << (c & 7);
+    }
+   }
+
+   st->put_u8(DELTA_CHUNKS);
+   st->write(dctx->bitmap.data(), bitmap_size);
+
+   for(uint32 c = 0; c < num_chunks; c++)
+   {
+    if(dctx->bitmap[c >> 3] & (1U << (c & 7)))
+    {
+     const uint32 offs = c * DeltaChunkSize;
+     const uint32 len = std::min<uint32>(DeltaChunkSize, size - offs);
+
+     st->write(e->shadow.get() + offs, len);
+     dctx->LastChangedBytes += len;
+    }
+   }
+  }
+ }
+}
+
+StateDeltaContext::StateDeltaContext()
+{
+ Reset();
+}
+
+StateDeltaContext::~StateDeltaContext()
+{
+
+}
+
+void StateDeltaContext::Reset(void)
+{
+ entries.clear();
+ bitmap.clear();
+ index = 0;
+ LastTotalBytes = 0;
+ LastChangedBytes = 0;
+}
+
 //
 // Fast raw chunk reader/writer.
 //
 template<bool load>
-static void FastRWChunk(Stream *st, const SFORMAT *sf)
+static void FastRWChunk(Stream *st, const SFORMAT *sf, StateDeltaContext* dctx)
 {
  while(sf->size || sf->name)	// Size can sometimes be zero, so also check for the text name.  These two should both be zero only at the end of a struct.
  {
@@ -316,7 +458,7 @@ static void FastRWChunk(Stream *st, const SFORMAT *sf)
 
   if(sf->size == ~0U)		/* Link to another struct.	*/
   {
-   FastRWChunk<load>(st, (const SFORMAT *)sf->data);
+   FastRWChunk<load>(st, (const SFORMAT *)sf->data, dctx);
 
    sf++;
    continue;
@@ -332,6 +474,16 @@ static void FastRWChunk(Stream *st, const SFORMAT *sf)
   // so we adjust it here.
   if(!sf->type)
    bytesize *= sizeof(bool);
+
+  if(dctx && (uint32)bytesize >= DeltaMinSize)
+  {
+   do
+   {
+    DeltaRW<load>(st, dctx, (uint8*)p, bytesize);
+   } while(p += repstride, repcount--);
+   sf++;
+   continue;
+  }
   
   //
   // Align large variables(e.g. RAM) to a 16-byte boundary for potentially faster memory copying, before we read/write it.
@@ -381,7 +533,7 @@ bool MDFNSS_StateAction(StateMem *sm, const unsigned load, const bool data_only,
     if(memcmp(sname_canary + 32, SSFastCanary, 8))
      throw MDFN_Error(0, _("Section canary is a zombie AAAAAAAAAAGH!"));
 
-    FastRWChunk<true>(st, sf);
+    FastRWChunk<true>(st, sf, sm->dctx);
    }
    else
    {
@@ -390,7 +542,7 @@ bool MDFNSS_StateAction(StateMem *sm, const unsigned load, const bool data_only,
     memcpy(sname_canary + 32, SSFastCanary, 8);
     st->write(sname_canary, 32 + 8);
 
-    FastRWChunk<false>(st, sf);
+    FastRWChunk<false>(st, sf, sm->dctx);
    }
   }
   else
@@ -586,6 +738,49 @@ void MDFNSS_SaveSM(Stream *st, bool data_only, const MDFN_Surface *surface, cons
 	}
 }
 
+//
+// Write-only stream that discards the data and only keeps track of the position and size, for measuring the size of a
+// save state without the copying or memory allocation overhead.
+//
+class StateSizeStream final : public Stream
+{
+ public:
+
+ StateSizeStream() : position(0), length(0) { }
+
+ virtual uint64 attributes(void) override { return ATTRIBUTE_WRITEABLE | ATTRIBUTE_SEEKABLE; }
+ virtual uint64 read(void* data, uint64 count, bool error_on_eos = true) override { throw MDFN_Error(0, "StateSizeStream::read()"); }
+ virtual void write(const void* data, uint64 count) override { position += count; length = std::max<uint64>(length, position); }
+ virtual void truncate(uint64 new_length) override { length = new_length; }
+ virtual void seek(int64 offset, int whence = SEEK_SET) override
+ {
+  switch(whence)
+  {
+   default: throw MDFN_Error(ErrnoHolder(EINVAL));
+   case SEEK_SET: position = offset; break;
+   case SEEK_CUR: position += offset; break;
+   case SEEK_END: position = length + offset; break;
+  }
+ }
+ virtual uint64 tell(void) override { return position; }
+ virtual uint64 size(void) override { return length; }
+ virtual void flush(void) override { }
+ virtual void close(void) override { }
+
+ private:
+ uint64 position;
+ uint64 length;
+};
+
+uint64 MDFNSS_GetSMSize(bool data_only)
+{
+ StateSizeStream st;
+
+ MDFNSS_SaveSM(&st, data_only);
+
+ return st.size();
+}
+
 void MDFNSS_LoadSM(Stream *st, bool data_only, const int fuzz)
 {
 	if(!MDFNGameInfo->StateAction)
@@ -645,6 +840,55 @@ void MDFNSS_LoadSM(Stream *st, bool data_only, const int fuzz)
 	}
 }
 
+void MDFNSS_SaveSMDelta(Stream* st, StateDeltaContext* ctx)
+{
+ if(!MDFNGameInfo->StateAction)
+  throw MDFN_Error(0, _("Module \"%s\" doesn't support save states."), MDFNGameInfo->shortname);
+ //
+ StateMem sm(st);
+
+ sm.dctx = ctx;
+ ctx->index = 0;
+ ctx->LastTotalBytes = 0;
+ ctx->LastChangedBytes = 0;
+
+ try
+ {
+  MDFN_StateAction(&sm, 0, true);
+  sm.ThrowDeferred();
+ }
+ catch(...)
+ {
+  // Shadow copies may be partially updated, so force a full save next time.
+  ctx->Reset();
+  throw;
+ }
+}
+
+void MDFNSS_LoadSMDelta(Stream* st, StateDeltaContext* ctx)
+{
+ if(!MDFNGameInfo->StateAction)
+  throw MDFN_Error(0, _("Module \"%s\" doesn't support save states."), MDFNGameInfo->shortname);
+ //
+ StateMem sm(st);
+
+ sm.dctx = ctx;
+ ctx->index = 0;
+ ctx->LastTotalBytes = 0;
+ ctx->LastChangedBytes = 0;
+
+ try
+ {
+  MDFN_StateAction(&sm, MEDNAFEN_VERSION_NUMERIC, true);
+  sm.ThrowDeferred();
+ }
+ catch(...)
+ {
+  ctx->Reset();
+  throw;
+ }
+}
+
 void MDFNSS_SaveInternal(Stream* st, void (*safunc)(StateMem*, const unsigned, const bool))
 {
  if(!MDFNGameInfo->StateAction)
@@ -59,8 +59,58 @@ enum : int
 void MDFNSS_SaveSM(Stream *st, bool data_only = false, const MDFN_Surface *surface = (MDFN_Surface *)NULL, const MDFN_Rect *DisplayRect = (MDFN_Rect*)NULL, const int32 *LineWidths = (int32*)NULL);
 void MDFNSS_LoadSM(Stream *st, bool data_only = false, const int fuzz = MDFNSS_FUZZ_DISABLED);
 
+//
+// Returns the exact number of bytes MDFNSS_SaveSM() would currently write(with no preview image), so that the caller
+// can save directly into, and load directly from, its own buffer via an ExtMemStream, with no intermediate copies.
+//
+// throws exceptions on errors.
+//
+uint64 MDFNSS_GetSMSize(bool data_only = false);
+
 void MDFNSS_CheckStates(void);
 
+//
+// Incremental data-only state saving/loading, mainly intended for realtime state rewinding, run-ahead, and netplay.
+//
+// The context keeps a shadow copy of every large state variable(RAM, VRAM, etc.) as of the last save or load done
+// through it.  MDFNSS_SaveSMDelta() writes a data-only state in which each large variable is represented by a bitmap
+// of changed chunks followed by only those chunks, so unchanged memory is compared but never copied into the stream.
+//
+// MDFNSS_LoadSMDelta() applies such a delta on top of the context's shadow copies and loads the result, so deltas
+// must be loaded in the same order they were saved, into a context that was in the same state as the saving context
+// when each delta was made(e.g. a netplay peer, or the same context for run-ahead).  The first save after creation or
+// Reset() writes large variables in full.
+//
+// throws exceptions on errors.
+//
+struct StateDeltaContext
+{
+ StateDeltaContext();
+ ~StateDeltaContext();
+
+ void Reset(void);
+
+ // Statistics from the last save or load.
+ uint64 LastTotalBytes;		// Total size of large variables.
+ uint64 LastChangedBytes;	// Size of changed chunks of large variables.
+
+ //
+ // Internal:
+ //
+ struct Entry
+ {
+  std::unique_ptr<uint8[]> shadow;
+  uint32 size = 0;
+ };
+
+ std::vector<Entry> entries;
+ std::vector<uint8> bitmap;
+ size_t index;
+};
+
+void MDFNSS_SaveSMDelta(Stream* st, StateDeltaContext* ctx);
+void MDFNSS_LoadSMDelta(Stream* st, StateDeltaContext* ctx);
+
 // For emulation modules' internal use.
 void MDFNSS_SaveInternal(Stream* st, void (*safunc)(StateMem*, const unsigned, const bool));
 void MDFNSS_LoadInternal(Stream* st, void (*safunc)(StateMem*, const unsigned, const bool));
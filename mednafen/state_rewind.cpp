@@ -25,6 +25,8 @@
 #include "state_rewind.h"
 
 #include <mednafen/MemoryStream.h>
+#include <mednafen/MThreading.h>
+#include <mednafen/AtomicFIFO.h>
 #include <mednafen/quicklz/quicklz.h>
 
 #if QLZ_COMPRESSION_LEVEL != 0
@@ -36,14 +38,29 @@ namespace Mednafen
 
 struct StateMemPacket
 {
-	std::unique_ptr<MemoryStream> data;
+	size_t arena_offset = 0;
+	uint32 compressed_len = 0;
 	uint32 uncompressed_len = 0;
+	bool keyframe = false;	// Compressed full state rather than XOR delta against the next newer state.
 };
 
 static bool Active = false;
 static bool Enabled = false;
 static std::vector<StateMemPacket> bcs;
 static size_t bcs_pos;
+static size_t bcs_count;	// Number of valid entries in bcs, ending just before bcs_pos.
+
+static uint32 KeyframeInterval;	// 0 = no keyframes, pure XOR chain.
+static uint32 DeltasSinceKeyframe;	// Number of consecutive delta entries at the newest end of bcs.
+
+//
+// Compressed packets are stored back-to-back in a circular arena, in the same order as in bcs; new packets are
+// allocated after the newest packet, and the oldest packets are evicted to make room.  The arena has a fixed size
+// when "srwmemory" is nonzero, otherwise it grows as needed and only "srwframes" limits the history length.
+//
+static std::unique_ptr<uint8[]> arena;
+static size_t arena_size;
+static bool arena_fixed;
 
 static uint32 SRW_AllocHint;
 static std::unique_ptr<MemoryStream> ss_prev;
@@ -54,12 +71,58 @@ static union
  char decompress[QLZ_SCRATCH_DECOMPRESS];
 } qlz_scratch;
 
+//
+// When threaded compression is enabled, raw states are handed off to the compression thread through CompQueue, and the
+// compression thread then owns ss_prev, bcs, and qlz_scratch.  The emulation thread may only touch those after waiting
+// for CompQueue to drain.
+//
+// A nullptr entry in CompQueue tells the compression thread to exit.
+//
+static MThreading::Thread* CompThread = nullptr;
+static MThreading::Sem* CompWakeupSem = nullptr;
+static MThreading::Sem* CompDoneSem = nullptr;
+static AtomicFIFO<MemoryStream*, 8> CompQueue;
+static std::atomic_bool CompFailed;
+static std::string CompErrorMessage;
+
+static void KillCompThread(void)
+{
+ if(CompThread)
+ {
+  while(!CompQueue.CanWrite())
+   MThreading::Sem_Wait(CompDoneSem);
+
+  CompQueue.Write(nullptr);
+  MThreading::Sem_Post(CompWakeupSem);
+  MThreading::Thread_Wait(CompThread, nullptr);
+  CompThread = nullptr;
+ }
+
+ if(CompDoneSem)
+ {
+  MThreading::Sem_Destroy(CompDoneSem);
+  CompDoneSem = nullptr;
+ }
+
+ if(CompWakeupSem)
+ {
+  MThreading::Sem_Destroy(CompWakeupSem);
+  CompWakeupSem = nullptr;
+ }
+}
+
 static void Cleanup(void)
 {
+ KillCompThread();
+
  bcs.clear();
+ arena.reset(nullptr);
+ arena_size = 0;
  ss_prev.reset(nullptr);
 }
 
+static int CompThreadEntry(void*);
+
 void MDFNSRW_Begin(void) noexcept
 {
  if(!Enabled)
@@ -71,10 +134,25 @@ void MDFNSRW_Begin(void) noexcept
   {
    bcs.resize(std::max<size_t>(3, MDFN_GetSettingUI("srwframes")) - 1);
    bcs_pos = 0;
+   bcs_count = 0;
+   KeyframeInterval = MDFN_GetSettingUI("srwkeyframes");
+   DeltasSinceKeyframe = 0;
    memset(&qlz_scratch, 0, sizeof(qlz_scratch));
 
+   arena_fixed = (MDFN_GetSettingUI("srwmemory") != 0);
+   arena_size = arena_fixed ? MDFN_GetSettingUI("srwmemory") : (1U << 20);
+   arena.reset(new uint8[arena_size]);
+
    SRW_AllocHint = 8192;
 
+   if(MDFN_GetSettingB("srwthread"))
+   {
+    CompFailed.store(false, std::memory_order_release);
+    CompWakeupSem = MThreading::Sem_Create();
+    CompDoneSem = MThreading::Sem_Create();
+    CompThread = MThreading::Thread_Create(CompThreadEntry, nullptr, "MDFN Rewind Compression");
+   }
+
    Active = true;
   }
   catch(std::exception &e)
@@ -107,18 +185,152 @@ static INLINE void DoXORFilter(MemoryStream* prev, MemoryStream* cur) noexcept
 }
 
 
-static INLINE std::unique_ptr<MemoryStream> DoCompress(MemoryStream* data)
+// age=1 is the entry just older than ss_prev
+static INLINE StateMemPacket* GetPacket(size_t age)
+{
+ return &bcs[(bcs_pos + bcs.size() - age) % bcs.size()];
+}
+
+static void EvictOldest(void)
+{
+ bcs_count--;
+ DeltasSinceKeyframe = std::min<size_t>(DeltasSinceKeyframe, bcs_count);
+}
+
+// Reallocate the arena, packing the live packets from oldest to newest at the start.
+static void GrowArena(size_t min_free)
+{
+ const size_t new_arena_size = std::max<size_t>(arena_size * 2, arena_size + min_free);
+ std::unique_ptr<uint8[]> new_arena(new uint8[new_arena_size]);
+ size_t offs = 0;
+
+ for(size_t age = bcs_count; age; age--)
+ {
+  StateMemPacket* smp = GetPacket(age);
+
+  memcpy(&new_arena[offs], &arena[smp->arena_offset], smp->compressed_len);
+  smp->arena_offset = offs;
+  offs += smp->compressed_len;
+ }
+
+ arena = std::move(new_arena);
+ arena_size = new_arena_size;
+}
+
+//
+// Find room for a packet of up to max_len bytes after the newest packet, evicting the oldest packets as needed, and
+// set smp->arena_offset accordingly.
+//
+static uint8* AllocPacket(StateMemPacket* smp, const size_t max_len)
+{
+ if(arena_fixed && max_len > arena_size)
+  throw MDFN_Error(0, _("Setting \"srwmemory\" is too small to hold a single state(%zu bytes)."), max_len);
+
+ for(;;)
+ {
+  if(!bcs_count)
+  {
+   if(max_len > arena_size)
+    GrowArena(max_len);
+
+   smp->arena_offset = 0;
+   break;
+  }
+  //
+  const StateMemPacket* newest = GetPacket(1);
+  const StateMemPacket* oldest = GetPacket(bcs_count);
+  const size_t head = newest->arena_offset + newest->compressed_len;
+  const size_t tail = oldest->arena_offset;
+
+  if(bcs_count > 1 && newest->arena_offset < oldest->arena_offset)
+  {
+   // Wrapped around, free space is in the middle.
+   if((tail - head) >= max_len)
+   {
+    smp->arena_offset = head;
+    break;
+   }
+  }
+  else
+  {
+   // Free space at the end, and at the start.
+   if((arena_size - head) >= max_len)
+   {
+    smp->arena_offset = head;
+    break;
+   }
+   else if(tail >= max_len)
+   {
+    smp->arena_offset = 0;
+    break;
+   }
+  }
+
+  if(arena_fixed)
+   EvictOldest();
+  else
+   GrowArena(max_len);
+ }
+
+ return &arena[smp->arena_offset];
+}
+
+static INLINE void DoCompress(MemoryStream* data, StateMemPacket* smp)
 {
  const uint32 uncompressed_len = data->size();
  const uint32 max_compressed_len = (uncompressed_len + 400);
- std::unique_ptr<MemoryStream> tmp_buf(new MemoryStream(max_compressed_len, -1));
- uint32 dst_len;
+ uint8* dst = AllocPacket(smp, max_compressed_len);
+
+ smp->compressed_len = qlz_compress(data->map(), (char*)dst, uncompressed_len, qlz_scratch.compress);
+ smp->uncompressed_len = uncompressed_len;
+}
+
+static INLINE std::unique_ptr<MemoryStream> DoDecompress(StateMemPacket* smp)
+{
+ std::unique_ptr<MemoryStream> ret(new MemoryStream(smp->uncompressed_len, -1));
 
- dst_len = qlz_compress(data->map(), (char*)tmp_buf->map(), uncompressed_len, qlz_scratch.compress);
- tmp_buf->truncate(dst_len);
- tmp_buf->shrink_to_fit();
+ qlz_decompress((char*)&arena[smp->arena_offset], ret->map(), qlz_scratch.decompress);
 
- return tmp_buf;
+ return ret;
+}
+
+//
+// Reconstruct the state "count" frames older than ss_prev, make it the new ss_prev, and discard the newer history.
+// At most one keyframe decode plus (KeyframeInterval - 1) delta decodes, regardless of "count".
+//
+static void DoSeek(size_t count)
+{
+ assert(count >= 1 && count <= bcs_count);
+
+ size_t age = count;
+
+ while(age && !GetPacket(age)->keyframe)
+  age--;
+
+ std::unique_ptr<MemoryStream> cur;
+
+ if(age)
+  cur = DoDecompress(GetPacket(age));
+ else
+  cur = std::move(ss_prev);
+
+ while(age < count)
+ {
+  std::unique_ptr<MemoryStream> tmp = DoDecompress(GetPacket(++age));
+  DoXORFilter(tmp.get(), cur.get());
+  cur = std::move(tmp);
+ }
+
+ bcs_pos = (bcs_pos + bcs.size() - count) % bcs.size();
+ bcs_count -= count;
+ ss_prev = std::move(cur);
+
+ DeltasSinceKeyframe = 0;
+ if(KeyframeInterval)
+ {
+  while(DeltasSinceKeyframe < bcs_count && !GetPacket(DeltasSinceKeyframe + 1)->keyframe)
+   DeltasSinceKeyframe++;
+ }
 }
 
 //
@@ -141,21 +353,90 @@ static bool DoRewind(void)
  //
  // If a compressed state exists, decompress it.
  //
- StateMemPacket* smp = &bcs[(bcs_pos + bcs.size() - 1) % bcs.size()];
+ if(bcs_count)
+  DoSeek(1);
+
+ return true;
+}
+
+//
+// XOR-filter and compress the previous state(if it exists) against ss_cur, then make ss_cur previous for next time.
+//
+static void CommitState(std::unique_ptr<MemoryStream> ss_cur)
+{
+ if(ss_prev)
+ {
+  const bool keyframe = KeyframeInterval && (DeltasSinceKeyframe + 1) >= KeyframeInterval;
+
+  if(keyframe)
+   DeltasSinceKeyframe = 0;
+  else
+  {
+   DoXORFilter(ss_prev.get(), ss_cur.get());
+   DeltasSinceKeyframe++;
+  }
+
+  //printf("Compress: %zu\n", ss_prev->size());
+
+  if(bcs_count == bcs.size())
+   EvictOldest();
 
- if(smp->data)
+  DoCompress(ss_prev.get(), &bcs[bcs_pos]);
+  bcs[bcs_pos].keyframe = keyframe;
+  bcs_pos = (bcs_pos + 1) % bcs.size();
+  bcs_count++;
+ }
+
+ ss_prev = std::move(ss_cur);
+}
+
+static int CompThreadEntry(void* data)
+{
+ for(;;)
  {
-  std::unique_ptr<MemoryStream> tmp(new MemoryStream(smp->uncompressed_len, -1));
-  qlz_decompress((char*)smp->data->map(), tmp->map(), qlz_scratch.decompress);
-  smp->data.reset(nullptr);
-  bcs_pos = (bcs_pos + bcs.size() - 1) % bcs.size();
+  while(!CompQueue.CanRead())
+   MThreading::Sem_Wait(CompWakeupSem);
   //
-  DoXORFilter(tmp.get(), ss_prev.get());
+  std::unique_ptr<MemoryStream> ss_cur(CompQueue.Peek());
+
+  if(!ss_cur)
+  {
+   CompQueue.AdvanceRead(1);
+   break;
+  }
+
+  if(!CompFailed.load(std::memory_order_acquire))
+  {
+   try
+   {
+    CommitState(std::move(ss_cur));
+   }
+   catch(std::exception& e)
+   {
+    CompErrorMessage = e.what();
+    CompFailed.store(true, std::memory_order_release);
+   }
+  }
+  ss_cur.reset(nullptr);
   //
-  ss_prev = std::move(tmp);
+  CompQueue.AdvanceRead(1);
+  MThreading::Sem_Post(CompDoneSem);
  }
 
- return true;
+ return 0;
+}
+
+//
+// Wait until the compression thread has room for another state, or until it has finished processing all
+// queued states if "drain" is true.
+//
+static void WaitCompQueue(bool drain)
+{
+ while(drain ? CompQueue.CanRead() : !CompQueue.CanWrite())
+  MThreading::Sem_Wait(CompDoneSem);
+
+ if(CompFailed.load(std::memory_order_acquire))
+  throw MDFN_Error(0, "%s", CompErrorMessage.c_str());
 }
 
 //
@@ -172,24 +453,14 @@ static void DoRecord(void)
 
  SRW_AllocHint = std::max<uint32>(SRW_AllocHint, ss_cur->size());
 
- //
- // Compress previous state if it exists.
- //
- if(ss_prev)
+ if(CompThread)
  {
-  DoXORFilter(ss_prev.get(), ss_cur.get());
-
-  //printf("Compress: %zu\n", ss_prev->size());
-
-  bcs[bcs_pos].data = DoCompress(ss_prev.get());
-  bcs[bcs_pos].uncompressed_len = ss_prev->size();
-  bcs_pos = (bcs_pos + 1) % bcs.size();
+  WaitCompQueue(false);
+  CompQueue.Write(ss_cur.release());
+  MThreading::Sem_Post(CompWakeupSem);
  }
-
- //
- // Make current state previous for next time.
- //
- ss_prev = std::move(ss_cur);
+ else
+  CommitState(std::move(ss_cur));
 }
 
 bool MDFNSRW_Frame(bool rewind) noexcept
@@ -201,6 +472,9 @@ bool MDFNSRW_Frame(bool rewind) noexcept
  {
   if(rewind)
   {
+   if(CompThread)
+    WaitCompQueue(true);
+
    return DoRewind();
   }
   else
@@ -219,6 +493,44 @@ bool MDFNSRW_Frame(bool rewind) noexcept
  }
 }
 
+uint32 MDFNSRW_SeekFrames(uint32 count) noexcept
+{
+ if(!Active)
+  return 0;
+
+ try
+ {
+  if(CompThread)
+   WaitCompQueue(true);
+
+  if(!ss_prev)
+   return 0;
+
+  count = std::min<size_t>(count, bcs_count);
+
+  if(count)
+   DoSeek(count);
+
+  ss_prev->rewind();
+  MDFNSS_LoadSM(ss_prev.get(), true);
+
+  return count;
+ }
+ catch(std::exception &e)
+ {
+  MDFNSRW_End();
+
+  MDFN_Notify(MDFN_NOTICE_ERROR, _("State rewinding error: %s"), e.what());
+
+  return 0;
+ }
+}
+
+uint32 MDFNI_SeekStateRewind(uint32 count)
+{
+ return MDFNSRW_SeekFrames(count);
+}
+
 bool MDFNI_EnableStateRewind(bool enable)
 {
  Enabled = enable;
@@ -28,6 +28,10 @@ bool MDFNSRW_IsRunning(void) noexcept;
 void MDFNSRW_Begin(void) noexcept;
 void MDFNSRW_End(void) noexcept;
 bool MDFNSRW_Frame(bool) noexcept;
+
+// Restores the state "count" frames back in the rewind history(clamped to what's available), discarding any newer
+// history, and returns the number of frames actually rewound.
+uint32 MDFNSRW_SeekFrames(uint32 count) noexcept;
 }
 
 #endif